@@ -8,13 +8,20 @@
 #include "base/command_line.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
-#include "content/public/app/content_main.h"
+#include "base/time/time.h"
 #include "headless/public/headless_browser.h"
 #include "net/base/filename_util.h"
 #include "phantomium/app/phantomium.h"
 #include "phantomium/app/phantomium_switches.h"
 #include "ui/gfx/geometry/size.h"
 
+#if defined(OS_LINUX)
+#include <time.h>
+
+#include "base/process/internal_linux.h"
+#include "base/process/process_handle.h"
+#endif
+
 #if defined(OS_WIN)
 #include "content/public/app/sandbox_helper_win.h"
 #include "sandbox/win/src/sandbox_types.h"
@@ -32,9 +39,45 @@ bool ParseWindowSize(const std::string& window_size,
   return false;
 }
 
+// Returns when the process was exec'd, so that the reported startup time also
+// covers loading and relocating the binary before main(). Elsewhere than on
+// Linux this falls back to the time of the call.
+base::TimeTicks GetProcessStartTime() {
+  base::TimeTicks now = base::TimeTicks::Now();
+#if defined(OS_LINUX)
+  // /proc/self/stat gives the start time in clock ticks since boot. Compare it
+  // against CLOCK_BOOTTIME, which counts from the same origin, to get the age
+  // of the process on a monotonic clock.
+  int64_t start_ticks = base::internal::ReadProcStatsAndGetFieldAsInt64(
+      base::GetCurrentProcId(), base::internal::VM_STARTTIME);
+  struct timespec ts;
+  if (start_ticks > 0 && clock_gettime(CLOCK_BOOTTIME, &ts) == 0) {
+    base::TimeDelta age = base::TimeDelta::FromTimeSpec(ts) -
+                          base::internal::ClockTicksToTimeDelta(start_ticks);
+    if (age >= base::TimeDelta())
+      return now - age;
+  }
+#endif
+  return now;
+}
+
+// Keeps browser subsystems which a one-shot print never needs off the startup
+// critical path. An empty GL implementation makes headless start with
+// --disable-gpu, and --disable-audio-output replaces the platform audio
+// manager, which BrowserMainLoop creates during startup, with a fake one.
+// Crash reporting is already off by default and headless is built without
+// extensions, so there is nothing to disable there.
+void ApplyFastStartOptions(
+    base::CommandLine* command_line,
+    headless::HeadlessBrowser::Options::Builder* builder) {
+  builder->SetGLImplementation(std::string());
+  command_line->AppendSwitch(phantomium::switches::kDisableAudioOutput);
+}
+
 #if defined(OS_WIN)
 int PhantomiumMain(HINSTANCE instance,
-                      sandbox::SandboxInterfaceInfo* sandbox_info) {
+                      sandbox::SandboxInterfaceInfo* sandbox_info,
+                      base::TimeTicks start_time) {
   base::CommandLine::Init(0, nullptr);
 
   headless::RunChildProcessIfNeeded(instance, sandbox_info);
@@ -42,12 +85,12 @@ int PhantomiumMain(HINSTANCE instance,
   builder.SetInstance(instance);
   builder.SetSandboxInfo(std::move(sandbox_info));
 #else
-int PhantomiumMain(int argc, const char** argv) {
+int PhantomiumMain(int argc, const char** argv, base::TimeTicks start_time) {
   base::CommandLine::Init(argc, argv);
   headless::RunChildProcessIfNeeded(argc, argv);
   headless::HeadlessBrowser::Options::Builder builder(argc, argv);
 #endif  // defined(OS_WIN)
-  phantomium::Phantomium phantomium;
+  phantomium::Phantomium phantomium(start_time);
   base::CommandLine& command_line(*base::CommandLine::ForCurrentProcess());
 
   // command-lind options
@@ -65,26 +108,22 @@ int PhantomiumMain(int argc, const char** argv) {
     builder.SetWindowSize(gfx::Size(800, 600));
   }
 
+  if (command_line.HasSwitch(phantomium::switches::kFastStart))
+    ApplyFastStartOptions(&command_line, &builder);
+
   return HeadlessBrowserMain(
     builder.Build(),
     base::BindOnce(
       &phantomium::Phantomium::OnStart, base::Unretained(&phantomium)));
 }
 
-int PhantomiumMain(const content::ContentMainParams& params) {
-#if defined(OS_WIN)
-  return PhantomiumMain(params.instance, params.sandbox_info);
-#else
-  return PhantomiumMain(params.argc, params.argv);
-#endif
-}
-
 int main(int argc, const char** argv) {
+  const base::TimeTicks start_time = GetProcessStartTime();
 #if defined(OS_WIN)
   sandbox::SandboxInterfaceInfo sandbox_info = {0};
   content::InitializeSandboxInfo(&sandbox_info);
-  return PhantomiumMain(0, &sandbox_info);
+  return PhantomiumMain(0, &sandbox_info, start_time);
 #else
-  return PhantomiumMain(argc, argv);
+  return PhantomiumMain(argc, argv, start_time);
 #endif  // defined(OS_WIN)
 }
@@ -14,8 +14,9 @@
 
 namespace phantomium {
 
-Phantomium::Phantomium()
-    : browser_(nullptr),
+Phantomium::Phantomium(base::TimeTicks start_time)
+    : start_time_(start_time),
+      browser_(nullptr),
       page_(nullptr),
       weak_factory_(this) {}
 
@@ -61,7 +62,7 @@ void Phantomium::OnPhantomiumPageDestruct() {
 }
 
 std::unique_ptr<PhantomiumPage> Phantomium::CreatePage() {
-  return base::WrapUnique(new PhantomiumPage());
+  return base::WrapUnique(new PhantomiumPage(start_time_));
 }
 
 }  // namespace phantomium
@@ -6,6 +6,7 @@
 #define PHANTOMIUM_APP_PHANTOMIUM_H_
 
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "headless/public/headless_browser.h"
 #include "headless/public/headless_browser_context.h"
 #include "phantomium/lib/phantomium_page.h"
@@ -14,7 +15,7 @@ namespace phantomium {
 
 class Phantomium : public PhantomiumPage::Observer {
  public:
-  Phantomium();
+  explicit Phantomium(base::TimeTicks start_time);
   ~Phantomium() override;
 
   void OnPhantomiumPageDestruct() override;
@@ -29,6 +30,8 @@ class Phantomium : public PhantomiumPage::Observer {
   std::unique_ptr<PhantomiumPage> CreatePage();
 
  private:
+  // When the process started, passed on to pages for timing.
+  base::TimeTicks start_time_;
   base::Lock lock_;  // Protects |browser_context_|.
   // The headless browser instance. Owned by the headless library.
   headless::HeadlessBrowser* browser_;
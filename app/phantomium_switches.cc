@@ -7,6 +7,11 @@
 namespace phantomium {
 namespace switches {
 
+// Trims browser startup for one-shot invocations by running without a GL
+// implementation and with a fake audio manager, since printing a page needs
+// neither the GPU nor audio output.
+const char kFastStart[] = "fast-start";
+
 // Uses a specified proxy server, overrides system settings. This switch only
 // affects HTTP and HTTPS requests.
 const char kProxyServer[] = "proxy-server";
@@ -6,10 +6,12 @@
 #define PHANTOMIUM_APP_PHANTOMIUM_SWITCHES_H_
 
 #include "content/public/common/content_switches.h"
+#include "media/base/media_switches.h"
 
 namespace phantomium {
 namespace switches {
 
+extern const char kFastStart[];
 extern const char kProxyServer[];
 extern const char kRemoteDebuggingAddress[];
 extern const char kUserAgent[];
@@ -19,6 +21,9 @@ extern const char kWindowSize[];
 using ::switches::kRemoteDebuggingPipe;
 using ::switches::kRemoteDebuggingPort;
 
+// Switches which are replicated from media.
+using ::switches::kDisableAudioOutput;
+
 }  // namespace switches
 }  // namespace phantomium
 
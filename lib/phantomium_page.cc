@@ -15,8 +15,12 @@
 
 namespace phantomium {
 
-PhantomiumPage::PhantomiumPage()
-    : processed_page_ready_(false),
+PhantomiumPage::PhantomiumPage(base::TimeTicks start_time)
+    : start_time_(start_time),
+      processed_page_ready_(false),
+      file_open_pending_(false),
+      file_created_(false),
+      failed_(false),
 #if !defined(CHROME_MULTIPLE_DLL_CHILD)
       browser_context_(nullptr),
       web_contents_(nullptr),
@@ -29,6 +33,13 @@ PhantomiumPage::~PhantomiumPage() = default;
 void PhantomiumPage::Load(const GURL& url, const base::FilePath& file_name) {
   file_name_ = file_name;
 
+  // Open the output file before the web contents is built, so that the file
+  // system round trip overlaps navigation rather than following the PDF, and
+  // a bad path is reported before any rendering is done.
+  file_task_runner_ = base::CreateSequencedTaskRunnerWithTraits(
+      {base::MayBlock(), base::TaskPriority::USER_BLOCKING,
+       base::TaskShutdownBehavior::BLOCK_SHUTDOWN});
+  OpenFile();
 
   headless::HeadlessWebContents::Builder builder(
       browser_context_->CreateWebContentsBuilder());
@@ -37,8 +48,10 @@ void PhantomiumPage::Load(const GURL& url, const base::FilePath& file_name) {
   web_contents_ = builder.Build();
   web_contents_->AddObserver(this);
 
-  file_task_runner_ = base::CreateSequencedTaskRunnerWithTraits(
-      {base::MayBlock(), base::TaskPriority::BACKGROUND});
+  // OpenFile() may have failed synchronously, before there was anything to
+  // shut down.
+  if (failed_)
+    Fail();
 }
 
 void PhantomiumPage::OnTargetCrashed(
@@ -109,79 +122,133 @@ void PhantomiumPage::PrintToPDF() {
 
 void PhantomiumPage::OnPDFCreated(
     std::unique_ptr<headless::page::PrintToPDFResult> result) {
+  // The page may have been shut down while printing, e.g. because the output
+  // file could not be opened.
+  if (!web_contents_)
+    return;
+
   if (!result) {
     LOG(ERROR) << "Print to PDF failed";
-    Shutdown();
+    Fail();
     return;
   }
 
   WriteFile(result->GetData());
 }
 
-void PhantomiumPage::WriteFile(const std::string& base64_data) {
-  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
-
+void PhantomiumPage::OpenFile() {
   // TODO(vitallium): If empty print to STDOUT
   if (file_name_.empty()) {
     LOG(ERROR) << "Empty filename";
-    Shutdown();
-    return;
-  }
-
-  std::string decoded_data;
-  if (!base::Base64Decode(base64_data, &decoded_data)) {
-    LOG(ERROR) << "Failed to decode base64 data";
-    OnFileOpened(std::string(), file_name_, base::File::FILE_ERROR_FAILED);
+    Fail();
     return;
   }
 
+  // The file is not truncated until the PDF has been written, so a failed run
+  // leaves an existing file as it was.
+  file_open_pending_ = true;
   file_proxy_ = std::make_unique<base::FileProxy>(file_task_runner_.get());
   if (!file_proxy_->CreateOrOpen(
-          file_name_, base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE,
+          file_name_, base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_WRITE,
           base::BindOnce(&PhantomiumPage::OnFileOpened,
-                         weak_factory_.GetWeakPtr(), decoded_data,
-                         file_name_))) {
+                         weak_factory_.GetWeakPtr()))) {
     // Operation could not be started.
-    OnFileOpened(std::string(), file_name_, base::File::FILE_ERROR_FAILED);
+    OnFileOpened(base::File::FILE_ERROR_FAILED);
   }
 }
 
-void PhantomiumPage::OnFileOpened(const std::string& decoded_data,
-                                  const base::FilePath file_name,
-                                  base::File::Error error_code) {
+void PhantomiumPage::WriteFile(const std::string& base64_data) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+
+  auto decoded_data = std::make_unique<std::string>();
+  if (!base::Base64Decode(base64_data, decoded_data.get())) {
+    LOG(ERROR) << "Failed to decode base64 data";
+    Fail();
+    return;
+  }
+
+  // The file is still being opened; OnFileOpened() picks the data up.
+  if (file_open_pending_) {
+    pending_data_ = std::move(decoded_data);
+    return;
+  }
+
+  WriteData(*decoded_data);
+}
+
+void PhantomiumPage::OnFileOpened(base::File::Error error_code) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  file_open_pending_ = false;
   if (!file_proxy_->IsValid()) {
-    LOG(ERROR) << "Writing to file " << file_name.value()
+    LOG(ERROR) << "Writing to file " << file_name_.value()
                << " was unsuccessful, could not open file: "
                << base::File::ErrorToString(error_code);
+    Fail();
+    return;
+  }
+  file_created_ = file_proxy_->created();
+
+  // A failure which happened while the file was being opened.
+  if (failed_) {
+    Fail();
     return;
   }
 
+  if (pending_data_) {
+    std::unique_ptr<std::string> decoded_data = std::move(pending_data_);
+    WriteData(*decoded_data);
+  }
+}
+
+void PhantomiumPage::WriteData(const std::string& decoded_data) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   auto buf = base::MakeRefCounted<net::IOBufferWithSize>(decoded_data.size());
   memcpy(buf->data(), decoded_data.data(), decoded_data.size());
 
+  LOG(INFO) << "Writing to file " << file_name_.value() << " "
+            << (base::TimeTicks::Now() - start_time_).InMilliseconds()
+            << " ms after process start.";
   if (!file_proxy_->Write(
           0, buf->data(), buf->size(),
           base::BindOnce(&PhantomiumPage::OnFileWritten,
-                         weak_factory_.GetWeakPtr(), file_name, buf->size()))) {
+                         weak_factory_.GetWeakPtr(), buf->size()))) {
     // Operation may have completed successfully or failed.
-    OnFileWritten(file_name, buf->size(), base::File::FILE_ERROR_FAILED, 0);
+    OnFileWritten(buf->size(), base::File::FILE_ERROR_FAILED, 0);
   }
 }
 
-void PhantomiumPage::OnFileWritten(const base::FilePath file_name,
-                                   const size_t length,
+void PhantomiumPage::OnFileWritten(const size_t length,
                                    base::File::Error error_code,
                                    int write_result) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
   if (write_result < static_cast<int>(length)) {
     // TODO(eseckler): Support recovering from partial writes.
-    LOG(ERROR) << "Writing to file " << file_name.value()
+    LOG(ERROR) << "Writing to file " << file_name_.value()
                << " was unsuccessful: "
                << base::File::ErrorToString(error_code);
-  } else {
-    LOG(INFO) << "Written to file " << file_name.value() << ".";
+    Fail();
+    return;
+  }
+
+  // Drop whatever an existing, longer file had past the new contents.
+  if (!file_proxy_->SetLength(
+          length, base::BindOnce(&PhantomiumPage::OnFileTruncated,
+                                 weak_factory_.GetWeakPtr()))) {
+    // Operation could not be started.
+    OnFileTruncated(base::File::FILE_ERROR_FAILED);
+  }
+}
+
+void PhantomiumPage::OnFileTruncated(base::File::Error error_code) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  // Not fatal: pipes and character devices such as /dev/stdout cannot be
+  // truncated, and have nothing left over to drop.
+  if (error_code != base::File::FILE_OK) {
+    DLOG(WARNING) << "Could not truncate file " << file_name_.value() << ": "
+                  << base::File::ErrorToString(error_code);
   }
+  LOG(INFO) << "Written to file " << file_name_.value() << ".";
+
   if (!file_proxy_->Close(base::BindOnce(&PhantomiumPage::OnFileClosed,
                                          weak_factory_.GetWeakPtr()))) {
     // Operation could not be started.
@@ -193,6 +260,35 @@ void PhantomiumPage::OnFileClosed(base::File::Error error_code) {
   Shutdown();
 }
 
+void PhantomiumPage::Fail() {
+  failed_ = true;
+  // Finished by OnFileOpened() or Load() respectively, so that an open in
+  // flight is never raced and Shutdown() has a web contents to tear down.
+  if (file_open_pending_ || !web_contents_)
+    return;
+
+  DiscardFile();
+  Shutdown();
+}
+
+void PhantomiumPage::DiscardFile() {
+  pending_data_.reset();
+  if (!file_proxy_)
+    return;
+
+  // Destroying the proxy closes the file on |file_task_runner_|, ahead of the
+  // delete below. Both run before shutdown completes as the runner blocks it.
+  file_proxy_.reset();
+  if (!file_created_)
+    return;
+
+  // The file was created by this run, so remove it rather than leave an empty
+  // or partial PDF behind. A preexisting file is left in place.
+  file_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(base::IgnoreResult(&base::DeleteFile),
+                                file_name_, false));
+}
+
 void PhantomiumPage::AddObserver(Observer* obs) {
   base::AutoLock lock(observers_lock_);
   observers_.AddObserver(obs);
@@ -9,6 +9,7 @@
 
 #include "base/files/file_proxy.h"
 #include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
 #include "headless/public/devtools/domains/inspector.h"
 #include "headless/public/devtools/domains/page.h"
 #include "headless/public/headless_browser.h"
@@ -25,7 +26,9 @@ class PhantomiumPage : public headless::HeadlessWebContents::Observer,
                        public headless::page::Observer {
  public:
   class Observer;
-  PhantomiumPage();
+  // |start_time| is when the process was started; it is used to report how
+  // long it took to produce the output.
+  explicit PhantomiumPage(base::TimeTicks start_time);
   ~PhantomiumPage() override;
 
   void Load(const GURL& url, const base::FilePath& file_name);
@@ -49,17 +52,28 @@ class PhantomiumPage : public headless::HeadlessWebContents::Observer,
   void PrintToPDF();
 
   void OnPDFCreated(std::unique_ptr<headless::page::PrintToPDFResult> result);
+  void OpenFile();
   void WriteFile(const std::string& base64_data);
-  void OnFileOpened(const std::string& decoded_data,
-                    const base::FilePath file_name,
-                    base::File::Error error_code);
-  void OnFileWritten(const base::FilePath file_name,
-                     const size_t length,
+  void OnFileOpened(base::File::Error error_code);
+  void WriteData(const std::string& decoded_data);
+  void OnFileWritten(const size_t length,
                      base::File::Error error_code,
                      int write_result);
+  void OnFileTruncated(base::File::Error error_code);
   void OnFileClosed(base::File::Error error_code);
+  // Cleans up the output file and shuts the page down after an error.
+  void Fail();
+  // Closes the output file, removing it if this run created it.
+  void DiscardFile();
 
+  base::TimeTicks start_time_;
   bool processed_page_ready_;
+  // Whether the output file is still being opened on |file_task_runner_|.
+  bool file_open_pending_;
+  // Whether the output file did not exist before this run.
+  bool file_created_;
+  // Whether an error occurred; see Fail().
+  bool failed_;
   base::FilePath file_name_;
 #if !defined(CHROME_MULTIPLE_DLL_CHILD)
   headless::HeadlessBrowserContext* browser_context_;
@@ -67,6 +81,8 @@ class PhantomiumPage : public headless::HeadlessWebContents::Observer,
 #endif
   scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
   std::unique_ptr<base::FileProxy> file_proxy_;
+  // PDF data which arrived before the output file finished opening.
+  std::unique_ptr<std::string> pending_data_;
   // The DevTools client used to control the tab.
   std::unique_ptr<headless::HeadlessDevToolsClient> devtools_client_;
   base::Lock observers_lock_;